@@ -10,6 +10,14 @@
 #include <random>
 #include <string>
 #include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 
 
 using namespace std;
@@ -33,6 +41,58 @@ struct User {
     vector<Item> purchaseHistory;
 };
 
+// "Customers also bought" index: for every item name, how many users bought it
+// together with each other item. Each neighbour list holds at most twice
+// maxNeighbours entries so memory stays bounded no matter how large the
+// catalogue grows; the spare half gives new pairs room to build up a count.
+struct CoPurchaseIndex {
+    unordered_map<string, unordered_map<string, int>> counts;
+    size_t maxNeighbours = 32;
+};
+
+// An order submitted at checkout, waiting for its payment to complete
+struct PaymentOrder {
+    int id;
+    string username;
+    vector<Item> items;
+    PaymentMethod method;
+    double total;
+};
+
+struct PaymentResult {
+    bool approved;
+    string message;
+};
+
+// A payment processor settles a whole batch of orders in one call and returns
+// one result per order, in the same order.
+using PaymentProcessor = function<vector<PaymentResult>(const vector<PaymentOrder>&)>;
+
+// Settings for the local simulated card backend
+struct SimulatedCardBackend {
+    chrono::milliseconds latency{ 300 }; // Round-trip time per batch
+    double failureRate = 0.05;          // Chance a card payment is declined
+    double cardLimit = 1000.0;          // Card payments above this are always declined
+};
+
+// Orders flow from checkout into pending, are settled in batches by the worker
+// threads, and land in completed until the session applies them. Destroying
+// the pipeline finishes any pending orders and joins the workers.
+struct PaymentPipeline {
+    PaymentProcessor processor;
+    size_t batchSize = 16;
+    chrono::milliseconds batchWindow{ 20 }; // How long a worker waits for a batch to fill
+    deque<PaymentOrder> pending;
+    deque<pair<PaymentOrder, PaymentResult>> completed;
+    mutex queueMutex;
+    condition_variable orderReady;
+    bool stopping = false;
+    int nextOrderId = 1;
+    vector<thread> workers;
+
+    ~PaymentPipeline();
+};
+
 std::string generateSalt(size_t length = 16) {
     const std::string chars =
         "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
@@ -55,7 +115,333 @@ string getCurrentTime() {
     return ss.str();
 }
 
-void checkout(vector<Item>& inventory, vector<Item>& cart, map<string, User>& users, const string& username) {
+// Orders neighbours by count, breaking ties by name so results are repeatable
+bool strongerNeighbour(const pair<string, int>& a, const pair<string, int>& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+}
+
+// Once an item's list outgrows twice the cap, keep only its strongest
+// maxNeighbours. Trimming all the way down leaves room for maxNeighbours new
+// pairs before the next trim, so newcomers are not evicted on arrival.
+void pruneNeighbours(unordered_map<string, int>& neighbours, size_t maxNeighbours) {
+    if (neighbours.size() <= 2 * maxNeighbours) {
+        return;
+    }
+
+    vector<pair<string, int>> ranked(neighbours.begin(), neighbours.end());
+    nth_element(ranked.begin(), ranked.begin() + maxNeighbours, ranked.end(), strongerNeighbour);
+    ranked.resize(maxNeighbours);
+    neighbours = unordered_map<string, int>(ranked.begin(), ranked.end());
+}
+
+// Count every pair of distinct items bought by the same user. Each item's row
+// is pruned as soon as it is filled, so at most one row at a time holds more
+// than twice maxNeighbours entries. The work is still quadratic in the number
+// of distinct items in the history.
+void countCoPurchases(const vector<Item>& history, unordered_map<string, unordered_map<string, int>>& counts, size_t maxNeighbours) {
+    unordered_set<string> seen;
+    vector<string> distinctItems;
+    for (const Item& item : history) {
+        if (seen.insert(item.name).second) {
+            distinctItems.push_back(item.name);
+        }
+    }
+
+    for (size_t i = 0; i < distinctItems.size(); ++i) {
+        auto& neighbours = counts[distinctItems[i]];
+        for (size_t j = 0; j < distinctItems.size(); ++j) {
+            if (j != i) {
+                ++neighbours[distinctItems[j]];
+            }
+        }
+        pruneNeighbours(neighbours, maxNeighbours);
+    }
+}
+
+// Function to build the co-purchase index from all users' purchase histories.
+// Users are split across worker threads, each counting into its own partial
+// index; the partials are then merged item by item. Lists are pruned as they
+// grow, so counts for rare pairs are approximate and each list stays small.
+void buildCoPurchaseIndex(CoPurchaseIndex& index, const map<string, User>& users) {
+    vector<const User*> userList;
+    for (const auto& entry : users) {
+        userList.push_back(&entry.second);
+    }
+
+    size_t workerCount = max<size_t>(1, thread::hardware_concurrency());
+    workerCount = min(workerCount, max<size_t>(1, userList.size()));
+
+    vector<unordered_map<string, unordered_map<string, int>>> partials(workerCount);
+    vector<thread> workers;
+    for (size_t w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&, w]() {
+            for (size_t i = w; i < userList.size(); i += workerCount) {
+                countCoPurchases(userList[i]->purchaseHistory, partials[w], index.maxNeighbours);
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    index.counts.clear();
+    for (auto& partial : partials) {
+        for (auto& entry : partial) {
+            auto& neighbours = index.counts[entry.first];
+            for (const auto& pairCount : entry.second) {
+                neighbours[pairCount.first] += pairCount.second;
+            }
+            pruneNeighbours(neighbours, index.maxNeighbours);
+        }
+        partial.clear();
+    }
+}
+
+// Function to fold a just-completed purchase into the index. Only items the
+// user had not bought before add new pairs, matching how a rebuild counts
+// them; a pair that was pruned earlier restarts from 1, so incremental and
+// rebuilt counts can differ for weak pairs.
+void updateCoPurchaseIndex(CoPurchaseIndex& index, const vector<Item>& previousHistory, const vector<Item>& purchased) {
+    unordered_set<string> owned;
+    for (const Item& item : previousHistory) {
+        owned.insert(item.name);
+    }
+
+    // Pair each new item with everything owned before it, including earlier new items
+    for (const Item& item : purchased) {
+        if (owned.find(item.name) != owned.end()) {
+            continue;
+        }
+        auto& neighbours = index.counts[item.name];
+        for (const string& other : owned) {
+            ++neighbours[other];
+            ++index.counts[other][item.name];
+            pruneNeighbours(index.counts[other], index.maxNeighbours);
+        }
+        pruneNeighbours(neighbours, index.maxNeighbours);
+        owned.insert(item.name);
+    }
+}
+
+// Function to get the items most often bought together with the given item
+vector<string> recommendItems(const CoPurchaseIndex& index, const string& itemName, size_t limit = 3) {
+    vector<string> result;
+    auto it = index.counts.find(itemName);
+    if (it == index.counts.end()) {
+        return result;
+    }
+
+    vector<pair<string, int>> ranked(it->second.begin(), it->second.end());
+    size_t top = min(limit, ranked.size());
+    partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(), strongerNeighbour);
+    for (size_t i = 0; i < top; ++i) {
+        result.push_back(ranked[i].first);
+    }
+    return result;
+}
+
+void displayRecommendations(const CoPurchaseIndex& index, const string& itemName) {
+    vector<string> recommended = recommendItems(index, itemName);
+    if (recommended.empty()) {
+        return;
+    }
+
+    cout << "Customers who bought " << itemName << " also bought: ";
+    for (size_t i = 0; i < recommended.size(); ++i) {
+        cout << (i > 0 ? ", " : "") << recommended[i];
+    }
+    cout << endl;
+}
+
+// Function to create a processor backed by the simulated card service. A batch
+// costs one round trip; cash is always approved, cards over the limit are
+// declined and the rest fail at random.
+PaymentProcessor makeSimulatedCardProcessor(const SimulatedCardBackend& backend) {
+    return [backend](const vector<PaymentOrder>& batch) {
+        thread_local mt19937 generator(random_device{}());
+        bernoulli_distribution declined(backend.failureRate);
+
+        this_thread::sleep_for(backend.latency);
+
+        vector<PaymentResult> results;
+        for (const PaymentOrder& order : batch) {
+            if (order.method == PaymentMethod::Card && order.total > backend.cardLimit) {
+                results.push_back({ false, "card limit exceeded" });
+            }
+            else if (order.method == PaymentMethod::Card && declined(generator)) {
+                results.push_back({ false, "card declined" });
+            }
+            else {
+                results.push_back({ true, order.method == PaymentMethod::Cash ? "cash received" : "card approved" });
+            }
+        }
+        return results;
+    };
+}
+
+// Worker loop: once an order arrives, wait up to batchWindow for the batch to
+// fill, settle up to batchSize orders in one processor call and publish the
+// results. Each worker has one batch in flight at a time. Exits once stopping
+// is set and the queue is empty.
+void paymentWorker(PaymentPipeline& pipeline) {
+    while (true) {
+        vector<PaymentOrder> batch;
+        {
+            unique_lock<mutex> lock(pipeline.queueMutex);
+            pipeline.orderReady.wait(lock, [&]() { return pipeline.stopping || !pipeline.pending.empty(); });
+            if (pipeline.pending.empty()) {
+                return;
+            }
+            pipeline.orderReady.wait_for(lock, pipeline.batchWindow, [&]() {
+                return pipeline.stopping || pipeline.pending.size() >= pipeline.batchSize;
+            });
+            if (pipeline.pending.empty()) {
+                continue; // Another worker took these orders
+            }
+            while (!pipeline.pending.empty() && batch.size() < pipeline.batchSize) {
+                batch.push_back(move(pipeline.pending.front()));
+                pipeline.pending.pop_front();
+            }
+        }
+
+        vector<PaymentResult> results;
+        try {
+            results = pipeline.processor(batch);
+        }
+        catch (const std::exception&) {
+            results.clear();
+        }
+        results.resize(batch.size(), PaymentResult{ false, "payment processor error" });
+
+        lock_guard<mutex> lock(pipeline.queueMutex);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            pipeline.completed.emplace_back(move(batch[i]), results[i]);
+        }
+    }
+}
+
+void startPaymentPipeline(PaymentPipeline& pipeline, PaymentProcessor processor, size_t workerCount = 2) {
+    pipeline.processor = move(processor);
+    pipeline.stopping = false;
+    for (size_t i = 0; i < workerCount; ++i) {
+        pipeline.workers.emplace_back(paymentWorker, ref(pipeline));
+    }
+}
+
+// Finishes every order still pending, then joins the workers
+void stopPaymentPipeline(PaymentPipeline& pipeline) {
+    {
+        lock_guard<mutex> lock(pipeline.queueMutex);
+        pipeline.stopping = true;
+    }
+    pipeline.orderReady.notify_all();
+    for (thread& worker : pipeline.workers) {
+        worker.join();
+    }
+    pipeline.workers.clear();
+}
+
+PaymentPipeline::~PaymentPipeline() {
+    stopPaymentPipeline(*this);
+}
+
+int submitPayment(PaymentPipeline& pipeline, PaymentOrder order) {
+    int id;
+    {
+        lock_guard<mutex> lock(pipeline.queueMutex);
+        id = order.id = pipeline.nextOrderId++;
+        pipeline.pending.push_back(move(order));
+    }
+    pipeline.orderReady.notify_all();
+    return id;
+}
+
+// Function to hold stock for an order until its payment completes. Fails
+// without touching the inventory if any item is missing or short.
+bool reserveStock(vector<Item>& inventory, const vector<Item>& items) {
+    map<string, int> needed;
+    for (const Item& item : items) {
+        needed[item.name] += item.quantity;
+    }
+
+    // Like releaseStock, only the first inventory entry with a name is used
+    vector<pair<Item*, int>> reserved;
+    for (const auto& entry : needed) {
+        auto it = find_if(inventory.begin(), inventory.end(), [&](const Item& item) { return item.name == entry.first; });
+        if (it == inventory.end()) {
+            cout << "Sorry, " << entry.first << " is no longer sold in the store.\n";
+            return false;
+        }
+        if (it->quantity < entry.second) {
+            cout << "Sorry, only " << it->quantity << " of " << entry.first << " left in stock.\n";
+            return false;
+        }
+        reserved.emplace_back(&*it, entry.second);
+    }
+
+    for (const auto& entry : reserved) {
+        entry.first->quantity -= entry.second;
+    }
+    return true;
+}
+
+// Function to return reserved stock after a failed payment. Items the owner
+// removed in the meantime stay removed.
+void releaseStock(vector<Item>& inventory, const vector<Item>& items) {
+    for (const auto& itemInCart : items) {
+        for (auto& itemInInventory : inventory) {
+            if (itemInCart.name == itemInInventory.name) {
+                itemInInventory.quantity += itemInCart.quantity;
+                break;
+            }
+        }
+    }
+}
+
+void logError(const string& error);
+
+// Function to commit finished payments: approved orders update the buyer's
+// purchase history and the recommendations, declined ones give their stock
+// back. A declined order's items return to the cart only if its buyer is the
+// one logged in. Runs on the session thread so the store data is never
+// touched by the payment workers.
+void applyCompletedPayments(PaymentPipeline& pipeline, vector<Item>& inventory, vector<Item>& cart, const string& sessionUser, map<string, User>& users, CoPurchaseIndex& recommendations) {
+    deque<pair<PaymentOrder, PaymentResult>> finished;
+    {
+        lock_guard<mutex> lock(pipeline.queueMutex);
+        finished.swap(pipeline.completed);
+    }
+
+    for (const auto& entry : finished) {
+        const PaymentOrder& order = entry.first;
+        const PaymentResult& result = entry.second;
+
+        if (!result.approved) {
+            releaseStock(inventory, order.items);
+            cout << "Payment for order #" << order.id << " ($" << fixed << setprecision(2) << order.total
+                << ") failed (" << result.message << ").";
+            if (!sessionUser.empty() && order.username == sessionUser) {
+                cart.insert(cart.end(), order.items.begin(), order.items.end());
+                cout << " The items are back in your cart; check out again to retry.";
+            }
+            cout << "\n";
+            stringstream ss;
+            ss << "Order #" << order.id << " for " << order.username << " ($" << fixed << setprecision(2) << order.total
+                << ") failed: " << result.message;
+            logError(ss.str());
+            continue;
+        }
+
+        // Update recommendations and the user's purchase history
+        auto& user = users[order.username];
+        updateCoPurchaseIndex(recommendations, user.purchaseHistory, order.items);
+        user.purchaseHistory.insert(user.purchaseHistory.end(), order.items.begin(), order.items.end());
+
+        cout << "Order #" << order.id << " is complete (" << result.message << "). Thank you for shopping with us.\n";
+    }
+}
+
+void checkout(vector<Item>& inventory, vector<Item>& cart, const string& username, PaymentPipeline& payments) {
     if (cart.empty()) {
         cout << "It looks like your cart is empty. Let's add some items before checking out.\n";
         return;
@@ -74,35 +460,25 @@ void checkout(vector<Item>& inventory, vector<Item>& cart, map<string, User>& us
     cin >> confirm;
 
     if (tolower(confirm) == 'y') {
-        cout << "Great! We're now processing your payment...\n";
-
-        // Update inventory
-        for (const auto& itemInCart : cart) {
-            for (auto& itemInInventory : inventory) {
-                if (itemInCart.name == itemInInventory.name) {
-                    itemInInventory.quantity -= itemInCart.quantity;
-                    break;
-                }
-            }
-        }
-
         PaymentMethod method = selectPaymentMethod();
         if (method == PaymentMethod::Cancel) {
             cout << "Checkout cancelled.\n";
             return;
         }
 
-        processPayment(method);
-
+        if (!reserveStock(inventory, cart)) {
+            cout << "Please update your cart and try again.\n";
+            return;
+        }
 
-        // Update user's purchase history
-        auto& user = users[username];
-        user.purchaseHistory.insert(user.purchaseHistory.end(), cart.begin(), cart.end());
+        // Hand the order to the payment workers; history is updated once the
+        // payment completes
+        int orderId = submitPayment(payments, PaymentOrder{ 0, username, cart, method, total });
 
         // Clear the cart
         cart.clear();
 
-        cout << "Your purchase was successful! Thank you for shopping with us.\n";
+        cout << "Your order #" << orderId << " has been submitted. We'll let you know once the payment is processed.\n";
     }
     else {
         cout << "No problem, take your time. Let us know when you're ready to check out.\n";
@@ -336,6 +712,30 @@ void viewCart(const vector<Item>& cart) {
             << ", Quantity: " << item.quantity << ", Category: " << item.category << endl;
     }
 }
+// Function to suggest items bought alongside the cart contents
+void displayCartRecommendations(const vector<Item>& cart, const CoPurchaseIndex& recommendations) {
+    // Suggest items bought alongside the cart contents that aren't in it yet
+    unordered_set<string> inCart;
+    for (const auto& item : cart) {
+        inCart.insert(item.name);
+    }
+    vector<string> suggestions;
+    for (const auto& item : cart) {
+        for (const string& name : recommendItems(recommendations, item.name)) {
+            if (inCart.insert(name).second) {
+                suggestions.push_back(name);
+            }
+        }
+    }
+
+    if (!suggestions.empty()) {
+        cout << "You might also like: ";
+        for (size_t i = 0; i < suggestions.size(); ++i) {
+            cout << (i > 0 ? ", " : "") << suggestions[i];
+        }
+        cout << endl;
+    }
+}
 void registerUser(map<string, User>& users) {
     User newUser;
     cout << "Enter a username: ";
@@ -445,22 +845,6 @@ void updateItemPrice(vector<Item>& inventory) {
     inventory[choice - 1].price = newPrice;
     cout << "Price updated successfully.\n";
 }
-void processPayment(PaymentMethod method) {
-    switch (method) {
-    case PaymentMethod::Cash:
-        cout << "Processing cash payment...\n";
-        // Simulate cash payment
-        break;
-    case PaymentMethod::Card:
-        cout << "Processing card payment...\n";
-        // Simulate card payment
-        break;
-    case PaymentMethod::Cancel:
-        cout << "Payment cancelled.\n";
-        break;
-    }
-}
-
 // Function for the owner menu
 void ownerMenu(vector<Item>& inventory) {
     char choice;
@@ -536,18 +920,27 @@ int main() {
     map<string, User> users; // Map to store user data (username -> User)
     vector<Item> inventory; // Vector to store items in the store
     vector<Item> cart;      // Vector to store items in the user's cart
+    CoPurchaseIndex recommendations; // "Customers also bought" index
 
     // Load user data from a file
     loadUserData(users);
+    buildCoPurchaseIndex(recommendations, users);
+
+    // Payments are settled in the background by the simulated card backend
+    PaymentPipeline payments;
+    startPaymentPipeline(payments, makeSimulatedCardProcessor(SimulatedCardBackend{}));
 
     // Define the owner's credentials (for demonstration purposes)
     const string ownerUsername = "owner";
     const string ownerPassword = ""; // Change this to a secure password
 
-    char choice;
+    string currentUser; // Username of the logged-in user, empty until someone logs in
+    int choice;
 
     // Main program loop
     do {
+        applyCompletedPayments(payments, inventory, cart, currentUser, users, recommendations);
+
         cout << "Options:\n";
         cout << "1. Add an item to the store\n";
         cout << "2. Display items in the store\n";
@@ -558,7 +951,8 @@ int main() {
         cout << "7. Log in as a user\n";
         cout << "8. Register an account\n";
         cout << "9. Log in as the owner\n"; // Added owner login option
-        cout << "10. Quit\n"; // Changed the option number
+        cout << "10. Check out\n";
+        cout << "11. Quit\n"; // Changed the option number
         cout << "Enter your choice: ";
 
         try {
@@ -569,7 +963,7 @@ int main() {
                 throw runtime_error("invalid imput please enter a valid option.");
             }
             switch (choice) {
-            case '1': {
+            case 1: {
                 Item newItem;
                 cout << "Enter item name: ";
                 cin.ignore();
@@ -584,14 +978,14 @@ int main() {
                 inventory.push_back(newItem);
                 break;
             }
-            case '2': {
+            case 2: {
                 cout << "Items in the store:\n";
                 for (const Item& item : inventory) {
                     cout << "Item: " << item.name << " - Price: $" << item.price << " - Quantity: " << item.quantity << " - Category: " << item.category << endl;
                 }
                 break;
             }
-            case '3': {
+            case 3: {
                 cout << "Items in the store:\n";
                 for (int i = 0; i < inventory.size(); ++i) {
                     cout << i + 1 << ". " << inventory[i].name << " - Price: $" << inventory[i].price << " - Quantity: " << inventory[i].quantity << " - Category: " << inventory[i].category << endl;
@@ -608,6 +1002,7 @@ int main() {
                         selectedItem.quantity = quantityToAdd;
                         cart.push_back(selectedItem);
                         cout << "Item added to the cart.\n";
+                        displayRecommendations(recommendations, selectedItem.name);
                     }
                     else {
                         cout << "Invalid quantity. Please try again.\n";
@@ -618,19 +1013,20 @@ int main() {
                 }
                 break;
             }
-            case '4': {
+            case 4: {
                 cout << "Items in the cart:\n";
                 for (const Item& item : cart) {
                     cout << "Item: " << item.name << " - Price: $" << item.price << " - Quantity: " << item.quantity << " - Category: " << item.category << endl;
                 }
+                displayCartRecommendations(cart, recommendations);
                 break;
             }
-            case '5': {
+            case 5: {
                 double total = calculateTotalPrice(cart);
                 cout << "Total price of items in the cart: $" << total << endl;
                 break;
             }
-            case '6': {
+            case 6: {
                 string username;
                 cout << "Enter your username: ";
                 cin.ignore();
@@ -643,7 +1039,7 @@ int main() {
                 }
                 break;
             }
-            case '7': {
+            case 7: {
                 string username, password;
                 cout << "Enter your username: ";
                 cin.ignore();
@@ -652,17 +1048,18 @@ int main() {
                 getline(cin, password);
                 if (validateCredentials(username, password, users)) {
                     cout << "Login successful.\n";
+                    currentUser = username;
                 }
                 else {
                     cout << "Invalid username or password. Please try again.\n";
                 }
                 break;
             }
-            case '8': {
+            case 8: {
                 registerUser(users);
                 break;
             }
-            case '9': {
+            case 9: {
                 string username, password;
                 cout << "Enter the owner username: ";
                 cin.ignore();
@@ -677,7 +1074,19 @@ int main() {
                 }
                 break;
             }
-            case '10': {
+            case 10: {
+                if (currentUser.empty()) {
+                    cout << "Please log in before checking out.\n";
+                }
+                else {
+                    checkout(inventory, cart, currentUser, payments);
+                }
+                break;
+            }
+            case 11: {
+                stopPaymentPipeline(payments);
+                // Nobody is shopping any more, so failed orders are only reported
+                applyCompletedPayments(payments, inventory, cart, "", users, recommendations);
                 saveUserData(users);
                 cout << "Exiting the program.\n";
                 break;
@@ -690,7 +1099,7 @@ int main() {
             cerr << "Error: " << e.what() << endl;
         }
 
-    } while (choice != '10');
+    } while (choice != 11);
 
     return 0;
 }
\ No newline at end of file